@@ -1,6 +1,10 @@
 /**
  * This is a c++ implementation of skip list introduced in 
  * [1] M. Herlihy, Y. Lev, V. Luchangco, and N. Shavit, “A Simple Optimistic Skiplist Algorithm,” in Structural Information and Communication Complexity, vol. 4474, G. Prencipe and S. Zaks, Eds., in Lecture Notes in Computer Science, vol. 4474. , Berlin, Heidelberg: Springer Berlin Heidelberg, 2007, pp. 124–138. doi: 10.1007/978-3-540-72951-8_11.
+ * PopMin / PeekMin follow the priority queue built on top of the skip list in
+ * [2] I. Lotan and N. Shavit, “Skiplist-Based Concurrent Priority Queues,” in Proceedings of the 14th International Parallel and Distributed Processing Symposium, 2000, pp. 263–268.
+ * PopApproxMin is the relaxed spray deletion described in
+ * [3] D. Alistarh, J. Kopinsky, J. Li, and N. Shavit, “The SprayList: A Scalable Relaxed Priority Queue,” in Proceedings of the 20th ACM SIGPLAN Symposium on Principles and Practice of Parallel Programming, 2015, pp. 11–20.
  **/
 
 #ifndef CONSKIPLIST_HPP
@@ -8,7 +12,13 @@
 
 #include "SkipList.hpp"
 #include <mutex>
+#include <algorithm>
 #include <atomic>
+#include <memory>
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <random>
 #include <iostream>
 
 template<typename T>
@@ -16,15 +26,15 @@ class ConSkipListNode {
 public:
     T key_;
     int top_layer_;
-    std::vector<std::shared_ptr<ConSkipListNode<T>>> next_;
+    // next_ is read by traversals while being relinked, so every access goes through an atomic load / store
+    std::vector<std::atomic<std::shared_ptr<ConSkipListNode<T>>>> next_;
     std::atomic<bool> marked_;
     std::atomic<bool> fully_linked_;
     std::mutex lock_;
 
-    ConSkipListNode(T key, int top_layer) {
+    ConSkipListNode(T key, int top_layer) : next_(top_layer + 1) {
         key_ = key;
         top_layer_ = top_layer;
-        next_.resize(top_layer + 1);
         marked_ = false;
         fully_linked_ = false;
     }
@@ -43,6 +53,15 @@ public:
 
     auto Contains(T key) -> bool;
 
+    // store the smallest key in key and remove it, return false if the list is empty
+    auto PopMin(T &key) -> bool;
+
+    // store the smallest key in key without removing it, return false if the list is empty
+    auto PeekMin(T &key) -> bool;
+
+    // remove one of the first O(p log^3 p) keys, where p is the number of threads popping concurrently
+    auto PopApproxMin(T &key, int num_threads) -> bool;
+
     void Print() {
         std::shared_ptr<ConSkipListNode<T>> p = LSentinel_;
         // print every layer
@@ -60,6 +79,20 @@ public:
 private:
     auto FindNode(T key, std::shared_ptr<ConSkipListNode<T>> *preds, std::shared_ptr<ConSkipListNode<T>> *succs) -> int;
 
+    // unlock preds[0..highestLocked], a pred shared by several layers is only locked once
+    void UnlockPreds(std::shared_ptr<ConSkipListNode<T>> *preds, int highestLocked);
+
+    // lock victim and mark it as deleted, return false if someone else has marked it
+    auto TryMark(const std::shared_ptr<ConSkipListNode<T>> &victim) -> bool;
+
+    // physically remove a victim that is marked and locked by the caller, release victim lock
+    // preds come from a FindNode for victim's key, and are searched again only if they turn out to be stale
+    void Unlink(const std::shared_ptr<ConSkipListNode<T>> &victim, std::shared_ptr<ConSkipListNode<T>> *preds,
+                std::shared_ptr<ConSkipListNode<T>> *succs);
+
+    // walk layer 0 from start and claim the first node which is fully linked and not marked
+    auto ClaimFrom(std::shared_ptr<ConSkipListNode<T>> start) -> std::shared_ptr<ConSkipListNode<T>>;
+
     std::shared_ptr<ConSkipListNode<T>> LSentinel_;
 
     std::shared_ptr<ConSkipListNode<T>> RSentinel_;
@@ -72,7 +105,7 @@ ConSkipList<T>::ConSkipList(int max_layer, float p) : SkipList<T>(max_layer, p)
     RSentinel_ = std::make_shared<ConSkipListNode<T>>(std::numeric_limits<T>::max(), this->max_layer_ - 1);
     for (int i = 0; i < this->max_layer_; ++i) {
         LSentinel_->next_[i] = RSentinel_;
-        RSentinel_->next_[i] = nullptr;
+        RSentinel_->next_[i].store(nullptr);
     }
 }
 
@@ -137,12 +170,10 @@ auto ConSkipList<T>::Add(T key) -> bool {
                 highestLocked = layer;
                 prevPred = pred;
             }
-            valid = !pred->marked_ && !succ->marked_ && pred->next_[layer] == succ;
+            valid = !pred->marked_ && !succ->marked_ && pred->next_[layer].load() == succ;
         }
         if (!valid) {
-            for (int layer = 0; layer <= highestLocked; ++layer) {
-                preds[layer]->lock_.unlock();
-            }
+            UnlockPreds(preds, highestLocked);
             continue;
         }
         std::shared_ptr<ConSkipListNode<T>> newNode = std::make_shared<ConSkipListNode<T>>(key, top_layer);
@@ -152,72 +183,33 @@ auto ConSkipList<T>::Add(T key) -> bool {
         }
         // linearization point
         newNode->fully_linked_ = true;
-        for (int layer = 0; layer <= highestLocked; ++layer) {
-            preds[layer]->lock_.unlock();
-        }
+        UnlockPreds(preds, highestLocked);
         return true;
     }
 }
 
 template<typename T>
 auto ConSkipList<T>::Remove(T key) -> bool {
-    std::shared_ptr<ConSkipListNode<T>> victim = nullptr;
-    bool isMarked = false;
     std::shared_ptr<ConSkipListNode<T>> preds[this->max_layer_];
     std::shared_ptr<ConSkipListNode<T>> succs[this->max_layer_];
-    while (true) {
-        int layer_check = FindNode(key, preds, succs);
-        if (layer_check != -1) {
-            victim = succs[layer_check];
-        }
-        /**
-         * bool okToDelete(Node* candidate, int lFound) {
-         *    return candidate−>fullyLinked && candidate−>topLayer==lFound && ! candidate−>marked;
-         * }
-         */
-        if (isMarked ||
-            (layer_check != -1 &&
-             victim->fully_linked_ && victim->top_layer_ == layer_check && !victim->marked_)) {
-            if (!isMarked) {
-                victim->lock_.lock();
-                if (victim->marked_) {
-                    victim->lock_.unlock();
-                    return false;
-                }
-                victim->marked_ = true;
-                isMarked = true;
-            }
-            int highestLocked = -1;
-            std::shared_ptr<ConSkipListNode<T>> pred, succ, prevPred = nullptr;
-            bool valid = true;
-            for (int layer = 0; valid && layer <= victim->top_layer_; ++layer) {
-                pred = preds[layer];
-                succ = succs[layer];
-                if (pred != prevPred) {
-                    pred->lock_.lock();
-                    highestLocked = layer;
-                    prevPred = pred;
-                }
-                valid = !pred->marked_ && pred->next_[layer] == succ;
-            }
-            if (!valid) {
-                for (int layer = 0; layer <= highestLocked; ++layer) {
-                    preds[layer]->lock_.unlock();
-                }
-                continue;
-            }
-            for (int layer = victim->top_layer_; layer >= 0; --layer) {
-                preds[layer]->next_[layer] = victim->next_[layer];
-            }
-            victim->lock_.unlock();
-            for (int layer = 0; layer <= highestLocked; ++layer) {
-                preds[layer]->lock_.unlock();
-            }
-            return true;
-        } else {
-            return false;
-        }
+    int layer_check = FindNode(key, preds, succs);
+    if (layer_check == -1) {
+        return false;
+    }
+    std::shared_ptr<ConSkipListNode<T>> victim = succs[layer_check];
+    /**
+     * bool okToDelete(Node* candidate, int lFound) {
+     *    return candidate−>fullyLinked && candidate−>topLayer==lFound && ! candidate−>marked;
+     * }
+     */
+    if (!victim->fully_linked_ || victim->top_layer_ != layer_check || victim->marked_) {
+        return false;
+    }
+    if (!TryMark(victim)) {
+        return false;
     }
+    Unlink(victim, preds, succs);
+    return true;
 }
 
 template<typename T>
@@ -228,5 +220,132 @@ auto ConSkipList<T>::Contains(T key) -> bool {
     return (layer != -1 && succs[layer]->fully_linked_ && !succs[layer]->marked_);
 }
 
+template<typename T>
+void ConSkipList<T>::UnlockPreds(std::shared_ptr<ConSkipListNode<T>> *preds, int highestLocked) {
+    std::shared_ptr<ConSkipListNode<T>> prevPred = nullptr;
+    for (int layer = 0; layer <= highestLocked; ++layer) {
+        if (preds[layer] != prevPred) {
+            preds[layer]->lock_.unlock();
+            prevPred = preds[layer];
+        }
+    }
+}
+
+template<typename T>
+auto ConSkipList<T>::TryMark(const std::shared_ptr<ConSkipListNode<T>> &victim) -> bool {
+    victim->lock_.lock();
+    if (victim->marked_) {
+        victim->lock_.unlock();
+        return false;
+    }
+    victim->marked_ = true;
+    return true;
+}
+
+template<typename T>
+void ConSkipList<T>::Unlink(const std::shared_ptr<ConSkipListNode<T>> &victim,
+                            std::shared_ptr<ConSkipListNode<T>> *preds,
+                            std::shared_ptr<ConSkipListNode<T>> *succs) {
+    while (true) {
+        int highestLocked = -1;
+        std::shared_ptr<ConSkipListNode<T>> pred, prevPred = nullptr;
+        bool valid = true;
+        for (int layer = 0; valid && layer <= victim->top_layer_; ++layer) {
+            pred = preds[layer];
+            if (pred != prevPred) {
+                pred->lock_.lock();
+                highestLocked = layer;
+                prevPred = pred;
+            }
+            valid = !pred->marked_ && pred->next_[layer].load() == victim;
+        }
+        if (!valid) {
+            UnlockPreds(preds, highestLocked);
+            // victim is marked, so no node with the same key can be added before it is unlinked
+            FindNode(victim->key_, preds, succs);
+            continue;
+        }
+        for (int layer = victim->top_layer_; layer >= 0; --layer) {
+            preds[layer]->next_[layer] = victim->next_[layer].load();
+        }
+        victim->lock_.unlock();
+        UnlockPreds(preds, highestLocked);
+        return;
+    }
+}
+
+template<typename T>
+auto ConSkipList<T>::ClaimFrom(std::shared_ptr<ConSkipListNode<T>> start) -> std::shared_ptr<ConSkipListNode<T>> {
+    std::shared_ptr<ConSkipListNode<T>> curr = start;
+    while (curr != nullptr && curr != RSentinel_) {
+        // linearization point of a successful pop is marking the node
+        if (curr->fully_linked_ && !curr->marked_ && TryMark(curr)) {
+            return curr;
+        }
+        curr = curr->next_[0];
+    }
+    return nullptr;
+}
+
+template<typename T>
+auto ConSkipList<T>::PopMin(T &key) -> bool {
+    std::shared_ptr<ConSkipListNode<T>> victim = ClaimFrom(LSentinel_->next_[0]);
+    if (victim == nullptr) {
+        return false;
+    }
+    key = victim->key_;
+    std::shared_ptr<ConSkipListNode<T>> preds[this->max_layer_];
+    std::shared_ptr<ConSkipListNode<T>> succs[this->max_layer_];
+    FindNode(victim->key_, preds, succs);
+    Unlink(victim, preds, succs);
+    return true;
+}
+
+template<typename T>
+auto ConSkipList<T>::PeekMin(T &key) -> bool {
+    std::shared_ptr<ConSkipListNode<T>> curr = LSentinel_->next_[0];
+    while (curr != nullptr && curr != RSentinel_) {
+        if (curr->fully_linked_ && !curr->marked_) {
+            key = curr->key_;
+            return true;
+        }
+        curr = curr->next_[0];
+    }
+    return false;
+}
+
+template<typename T>
+auto ConSkipList<T>::PopApproxMin(T &key, int num_threads) -> bool {
+    if (num_threads <= 1) {
+        return PopMin(key);
+    }
+    thread_local std::mt19937 gen(std::random_device{}());
+    // spray parameters as in [3]: start height log p, jump uniformly in [0, log^3 p] on every layer
+    int log_p = static_cast<int>(std::ceil(std::log2(num_threads)));
+    int height = std::min(log_p, this->max_layer_ - 1);
+    int jump = std::max(1, log_p * log_p * log_p);
+    std::uniform_int_distribution<> dis(0, jump);
+    std::shared_ptr<ConSkipListNode<T>> pred = LSentinel_;
+    for (int layer = height; layer >= 0; --layer) {
+        for (int steps = dis(gen); steps > 0; --steps) {
+            std::shared_ptr<ConSkipListNode<T>> next = pred->next_[layer];
+            if (next == nullptr || next == RSentinel_) {
+                break;
+            }
+            pred = next;
+        }
+    }
+    std::shared_ptr<ConSkipListNode<T>> victim = ClaimFrom(pred == LSentinel_ ? pred->next_[0].load() : pred);
+    if (victim == nullptr) {
+        // landed behind every live node, fall back to the exact minimum
+        return PopMin(key);
+    }
+    key = victim->key_;
+    std::shared_ptr<ConSkipListNode<T>> preds[this->max_layer_];
+    std::shared_ptr<ConSkipListNode<T>> succs[this->max_layer_];
+    FindNode(victim->key_, preds, succs);
+    Unlink(victim, preds, succs);
+    return true;
+}
 
 #endif // CONSKIPLIST_HPP
\ No newline at end of file
@@ -0,0 +1,309 @@
+/**
+ * Single-writer / multi-reader variant of NaiveSkipList.
+ * Add and Remove must only be called by one thread at a time, Contains may be called by any number of threads.
+ * The writer publishes a new node with release stores, bottom layer first, so a reader that reaches the node on
+ * some layer can always follow it down to layer 0. Readers traverse with acquire loads and never do read-modify-writes
+ * while traversing.
+ * Removed nodes are reclaimed with quiescent-state based reclamation: a reader announces the global epoch before a
+ * traversal and goes offline after it. The writer advances the epoch once per reclamation pass and frees a node once
+ * every reader is offline or has announced an epoch newer than the one the node was retired in.
+ * Every list has its own table of reader slots. A thread claims a free slot the first time it calls Contains on a list
+ * and gives it back when the thread exits.
+ **/
+
+#ifndef SWMRSKIPLIST_HPP
+#define SWMRSKIPLIST_HPP
+
+#include "SkipList.hpp"
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <iostream>
+
+template<typename T>
+class SwmrSkipListNode {
+public:
+    T key_;
+    int top_layer_;
+    std::atomic<SwmrSkipListNode<T> *> *next_;
+};
+
+template<typename T>
+class SwmrSkipList : public SkipList<T> {
+public:
+    // at most max_readers live threads may call Contains on this list, Contains throws std::length_error beyond that
+    SwmrSkipList(int max_layer, float p, int max_readers = 64);
+
+    ~SwmrSkipList();
+
+    auto Add(T key) -> bool;
+
+    auto Remove(T key) -> bool;
+
+    auto Contains(T key) -> bool;
+
+    // should be called by the writer
+    void Print() {
+        SwmrSkipListNode<T> *p = LSentinel_;
+        // print every layer
+        for (int layer = this->max_layer_ - 1; layer >= 0; --layer) {
+            std::cout << "layer " << layer << ": ";
+            SwmrSkipListNode<T> *cur = p->next_[layer].load(std::memory_order_relaxed);
+            while (cur != nullptr) {
+                std::cout << cur->key_ << " ";
+                cur = cur->next_[layer].load(std::memory_order_relaxed);
+            }
+            std::cout << std::endl;
+        }
+    }
+
+private:
+    // one cache line per reader so that announcing an epoch does not bounce between readers
+    struct alignas(64) ReaderSlot {
+        // epoch announced by the reader, 0 means the reader is offline, i.e. not inside a traversal
+        std::atomic<uint64_t> epoch_{0};
+        std::atomic<bool> in_use_{false};
+    };
+
+    // shared with the reader threads, so a thread exiting after the list is destroyed does not touch freed slots
+    struct ReaderTable {
+        explicit ReaderTable(int size) : size_(size), slots_(new ReaderSlot[size]) {}
+
+        ~ReaderTable() {
+            delete[] slots_;
+        }
+
+        int size_;
+        ReaderSlot *slots_;
+    };
+
+    struct ReaderRegistration {
+        uint64_t list_id_;
+        std::weak_ptr<ReaderTable> table_;
+        int index_;
+    };
+
+    // slots claimed by one thread, released when the thread exits
+    struct ReaderRegistry {
+        ~ReaderRegistry() {
+            for (auto &registration: registrations_) {
+                if (std::shared_ptr<ReaderTable> table = registration.table_.lock()) {
+                    table->slots_[registration.index_].in_use_.store(false, std::memory_order_release);
+                }
+            }
+        }
+
+        std::vector<ReaderRegistration> registrations_;
+    };
+
+    struct RetiredNode {
+        SwmrSkipListNode<T> *node_;
+        uint64_t epoch_;
+    };
+
+    // number of retired nodes before the writer scans the reader slots
+    static constexpr size_t kReclaimThreshold = 64;
+
+    auto FindNode(T key, SwmrSkipListNode<T> **preds, SwmrSkipListNode<T> **succs) -> int;
+
+    // free every retired node which no reader can still reference
+    void Reclaim();
+
+    static void FreeNode(SwmrSkipListNode<T> *node);
+
+    // slot of the calling thread in readers_, claimed on first use
+    auto ReaderIndex() -> int;
+
+    // read-mostly fields, shared by every reader
+    SwmrSkipListNode<T> *LSentinel_;
+
+    // never reused, so a thread cannot mistake a new list at the same address for one it registered with
+    uint64_t list_id_;
+
+    std::shared_ptr<ReaderTable> readers_;
+
+    // epoch a reader announces before a traversal, bumped by the writer at the start of every Reclaim
+    // on its own cache line, so the writer's stores do not invalidate the fields above
+    alignas(64) std::atomic<uint64_t> global_epoch_;
+
+    // writer-only fields, on their own cache line as well
+    alignas(64) std::vector<RetiredNode> retired_;
+
+    // retired_ size at which the writer calls Reclaim next
+    size_t reclaim_at_;
+};
+
+// implementation
+template<typename T>
+SwmrSkipList<T>::SwmrSkipList(int max_layer, float p, int max_readers) : SkipList<T>(max_layer, p) {
+    LSentinel_ = new SwmrSkipListNode<T>;
+    LSentinel_->key_ = std::numeric_limits<T>::min();
+    LSentinel_->top_layer_ = this->max_layer_ - 1;
+    LSentinel_->next_ = new std::atomic<SwmrSkipListNode<T> *>[this->max_layer_];
+    for (int i = 0; i < this->max_layer_; ++i) {
+        LSentinel_->next_[i].store(nullptr, std::memory_order_relaxed);
+    }
+    global_epoch_.store(1, std::memory_order_relaxed);
+    reclaim_at_ = kReclaimThreshold;
+    static std::atomic<uint64_t> next_list_id(0);
+    list_id_ = next_list_id.fetch_add(1);
+    readers_ = std::make_shared<ReaderTable>(max_readers);
+}
+
+template<typename T>
+SwmrSkipList<T>::~SwmrSkipList() {
+    // no reader may be running now, so everything can be freed
+    for (auto &retired: retired_) {
+        FreeNode(retired.node_);
+    }
+    SwmrSkipListNode<T> *p = LSentinel_;
+    SwmrSkipListNode<T> *q = nullptr;
+    while (p != nullptr) {
+        q = p->next_[0].load(std::memory_order_relaxed);
+        FreeNode(p);
+        p = q;
+    }
+}
+
+template<typename T>
+void SwmrSkipList<T>::FreeNode(SwmrSkipListNode<T> *node) {
+    delete[] node->next_;
+    delete node;
+}
+
+template<typename T>
+auto SwmrSkipList<T>::ReaderIndex() -> int {
+    thread_local ReaderRegistry registry;
+    std::vector<ReaderRegistration> &registrations = registry.registrations_;
+    for (auto &registration: registrations) {
+        if (registration.list_id_ == list_id_) {
+            return registration.index_;
+        }
+    }
+    // first Contains of this thread on this list, forget lists which have been destroyed meanwhile
+    std::erase_if(registrations, [](const ReaderRegistration &registration) {
+        return registration.table_.expired();
+    });
+    for (int i = 0; i < readers_->size_; ++i) {
+        bool expected = false;
+        if (readers_->slots_[i].in_use_.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            registrations.push_back({list_id_, readers_, i});
+            return i;
+        }
+    }
+    throw std::length_error("SwmrSkipList: more than max_readers threads call Contains");
+}
+
+template<typename T>
+auto SwmrSkipList<T>::FindNode(T key, SwmrSkipListNode<T> **preds, SwmrSkipListNode<T> **succs) -> int {
+    // only the writer calls this, and nobody else modifies the list
+    SwmrSkipListNode<T> *p = LSentinel_;
+    int lastFound = -1;
+    for (int layer = this->max_layer_ - 1; layer >= 0; --layer) {
+        SwmrSkipListNode<T> *cur = p->next_[layer].load(std::memory_order_relaxed);
+        while (cur != nullptr && cur->key_ < key) {
+            p = cur;
+            cur = cur->next_[layer].load(std::memory_order_relaxed);
+        }
+        if (lastFound == -1 && cur != nullptr && cur->key_ == key) {
+            lastFound = layer;
+        }
+        preds[layer] = p;
+        succs[layer] = cur;
+    }
+    return lastFound;
+}
+
+template<typename T>
+auto SwmrSkipList<T>::Add(T key) -> bool {
+    SwmrSkipListNode<T> *preds[this->max_layer_];
+    SwmrSkipListNode<T> *succs[this->max_layer_];
+    int layer = FindNode(key, preds, succs);
+    if (layer != -1) {
+        return false;
+    }
+    auto *new_node = new SwmrSkipListNode<T>;
+    new_node->key_ = key;
+    new_node->top_layer_ = this->RandomLayer();
+    new_node->next_ = new std::atomic<SwmrSkipListNode<T> *>[new_node->top_layer_ + 1];
+    for (int i = 0; i <= new_node->top_layer_; ++i) {
+        new_node->next_[i].store(succs[i], std::memory_order_relaxed);
+    }
+    // publish bottom layer first, the release store makes key_ and next_ visible to readers that reach the node
+    for (int i = 0; i <= new_node->top_layer_; ++i) {
+        preds[i]->next_[i].store(new_node, std::memory_order_release);
+    }
+    return true;
+}
+
+template<typename T>
+auto SwmrSkipList<T>::Remove(T key) -> bool {
+    SwmrSkipListNode<T> *preds[this->max_layer_];
+    SwmrSkipListNode<T> *succs[this->max_layer_];
+    int layer = FindNode(key, preds, succs);
+    if (layer == -1) {
+        return false;
+    }
+    SwmrSkipListNode<T> *node_to_remove = succs[layer];
+    // unlink top layer first, node_to_remove->next_ is left intact for readers still standing on it
+    for (int i = layer; i >= 0; --i) {
+        preds[i]->next_[i].store(node_to_remove->next_[i].load(std::memory_order_relaxed), std::memory_order_release);
+    }
+    retired_.push_back({node_to_remove, global_epoch_.load(std::memory_order_relaxed)});
+    if (retired_.size() >= reclaim_at_) {
+        Reclaim();
+        // nodes kept by a slow reader should not make every following Remove scan again
+        reclaim_at_ = retired_.size() + kReclaimThreshold;
+    }
+    return true;
+}
+
+template<typename T>
+void SwmrSkipList<T>::Reclaim() {
+    // every node in retired_ is already unlinked, readers announcing the new epoch can no longer reach any of them
+    uint64_t oldest = global_epoch_.load(std::memory_order_relaxed) + 1;
+    global_epoch_.store(oldest, std::memory_order_release);
+    // pairs with the fence in Contains: a reader whose announcement we miss sees every unlink before this point
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (int i = 0; i < readers_->size_; ++i) {
+        uint64_t epoch = readers_->slots_[i].epoch_.load(std::memory_order_acquire);
+        if (epoch != 0 && epoch < oldest) {
+            oldest = epoch;
+        }
+    }
+    size_t kept = 0;
+    for (auto &retired: retired_) {
+        if (retired.epoch_ < oldest) {
+            FreeNode(retired.node_);
+        } else {
+            retired_[kept++] = retired;
+        }
+    }
+    retired_.resize(kept);
+}
+
+template<typename T>
+auto SwmrSkipList<T>::Contains(T key) -> bool {
+    ReaderSlot &slot = readers_->slots_[ReaderIndex()];
+    // go online
+    slot.epoch_.store(global_epoch_.load(std::memory_order_acquire), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    SwmrSkipListNode<T> *p = LSentinel_;
+    bool found = false;
+    for (int layer = this->max_layer_ - 1; layer >= 0 && !found; --layer) {
+        SwmrSkipListNode<T> *cur = p->next_[layer].load(std::memory_order_acquire);
+        while (cur != nullptr && cur->key_ < key) {
+            p = cur;
+            cur = cur->next_[layer].load(std::memory_order_acquire);
+        }
+        found = cur != nullptr && cur->key_ == key;
+    }
+    // go offline, the release store orders every read above before the writer may free a node
+    slot.epoch_.store(0, std::memory_order_release);
+    return found;
+}
+
+#endif // SWMRSKIPLIST_HPP
@@ -1,6 +1,9 @@
 #include "NaiveSkipList.hpp"
 #include "ConSkipList.hpp"
+#include "SwmrSkipList.hpp"
 #include <thread>
+#include <chrono>
+#include <queue>
 
 
 void test_naive_skip_list() {
@@ -58,6 +61,49 @@ void test_naive_skip_list() {
     nsl.Print();
 }
 
+void test_swmr_skip_list() {
+    SwmrSkipList<int> ssl(8, 0.5);
+    bool ok = true;
+    // add / remove / contains return values
+    ok = ok && ssl.Add(1) && ssl.Add(2) && !ssl.Add(1);
+    ok = ok && ssl.Contains(1) && ssl.Contains(2) && !ssl.Contains(3);
+    ok = ok && ssl.Remove(1) && !ssl.Remove(1) && !ssl.Remove(3);
+    // removed key is gone, and can be added again
+    ok = ok && !ssl.Contains(1) && ssl.Contains(2);
+    ok = ok && ssl.Add(1) && ssl.Contains(1);
+    std::cout << "Add / Remove / Contains results: " << ok << std::endl;
+
+    // 1000-1099 are never removed, a reader checks them while the writer removes enough keys to reclaim nodes
+    for (int k = 1000; k < 1100; ++k) {
+        ssl.Add(k);
+    }
+    std::atomic<bool> writer_done(false);
+    std::atomic<int> misses(0);
+    std::thread reader([&ssl, &writer_done, &misses]() {
+        while (!writer_done) {
+            for (int k = 1000; k < 1100; ++k) {
+                if (!ssl.Contains(k)) {
+                    ++misses;
+                }
+            }
+        }
+    });
+    bool removed = true;
+    for (int round = 0; round < 10; ++round) {
+        for (int k = 0; k < 1000; ++k) {
+            ssl.Add(k);
+        }
+        for (int k = 0; k < 1000; ++k) {
+            removed = removed && ssl.Remove(k) && !ssl.Contains(k);
+        }
+        // let the reader announce newer epochs, so retired nodes are actually freed
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    writer_done = true;
+    reader.join();
+    std::cout << "Removed keys not found: " << removed << ", misses while reclaiming: " << misses << std::endl;
+}
+
 void test_concurrent_skip_list() {
     ConSkipList<int> csl(4, 0.6);
     // create 4 threads to add 0, 1 ,2, 3, 4, 5, 6, 7, 8, 9 in random order
@@ -166,6 +212,49 @@ void test_concurrent_skip_list() {
     csl.Print();
 }
 
+void test_pop_min() {
+    ConSkipList<int> csl(8, 0.5);
+    // add 0-999 in a scrambled order, PopMin should return them in ascending order
+    for (int k = 0; k < 1000; ++k) {
+        csl.Add(k * 367 % 1000);
+    }
+    bool ordered = true;
+    bool peek_agrees = true;
+    int expected = 0;
+    int peeked, popped;
+    while (csl.PeekMin(peeked)) {
+        csl.PopMin(popped);
+        peek_agrees = peek_agrees && peeked == popped;
+        ordered = ordered && popped == expected;
+        ++expected;
+    }
+    std::cout << "PopMin ascending: " << (ordered && expected == 1000)
+              << ", PeekMin agrees with PopMin: " << peek_agrees << std::endl;
+
+    // 4 threads pop 0-9999 with PopApproxMin, every key should be popped exactly once
+    for (int k = 0; k < 10000; ++k) {
+        csl.Add(k);
+    }
+    std::vector<std::atomic<int>> times_popped(10000);
+    std::vector<std::thread> threads;
+    for (int j = 0; j < 4; ++j) {
+        threads.emplace_back([&csl, &times_popped]() {
+            int key;
+            while (csl.PopApproxMin(key, 4)) {
+                ++times_popped[key];
+            }
+        });
+    }
+    for (auto &t: threads) {
+        t.join();
+    }
+    bool exactly_once = true;
+    for (auto &count: times_popped) {
+        exactly_once = exactly_once && count == 1;
+    }
+    std::cout << "PopApproxMin pops every key exactly once: " << exactly_once << std::endl;
+}
+
 void pressure_test() {
     // add ranged from 0-200,000, with 1, 2, 4, 8 threads
     std::atomic<int> progress(0);
@@ -261,13 +350,159 @@ void pressure_test_interleave() {
     }
 }
 
+void pressure_test_pop_min() {
+    // prefill 200,000 keys, then pop all of them with 1, 2, 4, 8 threads
+    // compare PopMin, PopApproxMin and a std::priority_queue guarded by a mutex
+    const int total = 200000;
+    for (int i = 0; i < 4; ++i) {
+        int num_threads = 1 << i;
+        std::cout << "Number of threads: " << num_threads << std::endl;
+        for (int mode = 0; mode < 3; ++mode) {
+            ConSkipList<int> csl(16, 0.5);
+            std::priority_queue<int, std::vector<int>, std::greater<>> pq;
+            std::mutex pq_lock;
+            for (int k = 0; k < total; ++k) {
+                if (mode == 2) {
+                    pq.push(k);
+                } else {
+                    csl.Add(k);
+                }
+            }
+            std::atomic<int> popped(0);
+            // time start
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<std::thread> threads;
+            for (int j = 0; j < num_threads; ++j) {
+                threads.emplace_back([&csl, &pq, &pq_lock, &popped, num_threads, mode]() {
+                    int key;
+                    for (int k = 0; k < total / num_threads; ++k) {
+                        bool ok;
+                        if (mode == 0) {
+                            ok = csl.PopMin(key);
+                        } else if (mode == 1) {
+                            ok = csl.PopApproxMin(key, num_threads);
+                        } else {
+                            std::lock_guard<std::mutex> guard(pq_lock);
+                            ok = !pq.empty();
+                            if (ok) {
+                                key = pq.top();
+                                pq.pop();
+                            }
+                        }
+                        if (ok) {
+                            ++popped;
+                        }
+                    }
+                });
+            }
+            for (auto &t: threads) {
+                t.join();
+            }
+            // time end
+            auto end = std::chrono::high_resolution_clock::now();
+            const char *name[] = {"PopMin", "PopApproxMin", "mutex priority_queue"};
+            std::cout << name[mode] << ": popped " << popped << " / " << total << ", time elapsed: "
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms"
+                      << std::endl;
+        }
+    }
+}
+
+void pressure_test_swmr() {
+    // the list holds 0-100,000, one writer adds 100,000-200,000 and then removes its even keys,
+    // while 1, 2, 4, 8 readers run contains on 0-100,000 until the writer is done
+    // compare SwmrSkipList and ConSkipList used in the same way, and a single-threaded NaiveSkipList writer
+    const int total = 100000;
+    {
+        NaiveSkipList<int> nsl(16, 0.5);
+        for (int k = 0; k < total; ++k) {
+            nsl.Add(k);
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int k = total; k < 2 * total; ++k) {
+            nsl.Add(k);
+        }
+        for (int k = total; k < 2 * total; k += 2) {
+            nsl.Remove(k);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "NaiveSkipList single-threaded writer: "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms" << std::endl;
+    }
+    for (int i = 0; i < 4; ++i) {
+        int num_readers = 1 << i;
+        std::cout << "Number of readers: " << num_readers << std::endl;
+        for (int mode = 0; mode < 2; ++mode) {
+            SwmrSkipList<int> ssl(16, 0.5);
+            ConSkipList<int> csl(16, 0.5);
+            SkipList<int> *sl = mode == 0 ? static_cast<SkipList<int> *>(&ssl) : &csl;
+            for (int k = 0; k < total; ++k) {
+                sl->Add(k);
+            }
+            std::atomic<bool> writer_done(false);
+            long long writer_ms = 0;
+            std::thread writer([sl, &writer_done, &writer_ms]() {
+                auto start = std::chrono::high_resolution_clock::now();
+                for (int k = total; k < 2 * total; ++k) {
+                    sl->Add(k);
+                }
+                for (int k = total; k < 2 * total; k += 2) {
+                    sl->Remove(k);
+                }
+                auto end = std::chrono::high_resolution_clock::now();
+                writer_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+                writer_done = true;
+            });
+            // every reader times its own loop, the throughput is the sum of the readers' ops/s
+            std::vector<double> reader_ops_per_s(num_readers);
+            std::atomic<int> misses(0);
+            std::vector<std::thread> readers;
+            for (int j = 0; j < num_readers; ++j) {
+                readers.emplace_back([sl, &writer_done, &reader_ops_per_s, &misses, j]() {
+                    std::random_device rd;
+                    std::mt19937 gen(rd());
+                    std::uniform_int_distribution<> dis(0, total - 1);
+                    long long ops = 0;
+                    auto start = std::chrono::high_resolution_clock::now();
+                    while (!writer_done) {
+                        // keys below total are never removed
+                        if (!sl->Contains(dis(gen))) {
+                            ++misses;
+                        }
+                        ++ops;
+                    }
+                    auto end = std::chrono::high_resolution_clock::now();
+                    double seconds = std::chrono::duration<double>(end - start).count();
+                    reader_ops_per_s[j] = seconds > 0 ? ops / seconds : 0;
+                });
+            }
+            writer.join();
+            for (auto &t: readers) {
+                t.join();
+            }
+            double ops_per_s = 0;
+            for (double r: reader_ops_per_s) {
+                ops_per_s += r;
+            }
+            const char *name[] = {"SwmrSkipList", "ConSkipList"};
+            std::cout << name[mode] << ": writer " << writer_ms << "ms, readers " << static_cast<long long>(ops_per_s)
+                      << " contains/s, misses " << misses << std::endl;
+        }
+    }
+}
 
 int main(int argc, char const *argv[]) {
 //    std::cout<<"Naive Skip List\n";
 //    test_naive_skip_list();
 //    std::cout<<"Concurrent Skip List\n";
 //    test_concurrent_skip_list();
+    std::cout<<"SWMR Skip List\n";
+    test_swmr_skip_list();
+    std::cout<<"Pop Min\n";
+    test_pop_min();
 //    pressure_test();
     pressure_test_interleave();
+//    pressure_test_pop_min();
+//    pressure_test_swmr();
     return 0;
 }
\ No newline at end of file